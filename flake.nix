@@ -34,6 +34,8 @@
         mono-gateway-libfci = final.callPackage ./pkgs/libfci { };
         mono-gateway-cmm = final.callPackage ./pkgs/cmm { };
         mono-gateway-dpa-app = final.callPackage ./pkgs/dpa-app { };
+        mono-gateway-ehash-sim = final.callPackage ./pkgs/ehash-sim { };
+        mono-gateway-ehash-stats = final.callPackage ./pkgs/ehash-stats { };
       };
 
       # Cross-compiled pkgs for building individual packages on x86_64
@@ -42,6 +44,12 @@
         crossSystem = "aarch64-linux";
         overlays = [ overlay ];
       };
+
+      # Host pkgs for development tools that run on the build machine
+      hostPkgs = import nixpkgs {
+        system = "x86_64-linux";
+        overlays = [ overlay ];
+      };
     in
     {
       overlays.default = overlay;
@@ -90,7 +98,13 @@
         libfci = crossPkgs.mono-gateway-libfci;
         cmm = crossPkgs.mono-gateway-cmm;
         dpa-app = crossPkgs.mono-gateway-dpa-app;
+        ehash-stats = crossPkgs.mono-gateway-ehash-stats;
         rootfsImage = self.nixosConfigurations.gateway.config.system.build.rootfsImage;
       };
+
+      # Development tools (native x86_64)
+      packages.x86_64-linux = {
+        ehash-sim = hostPkgs.mono-gateway-ehash-sim;
+      };
     };
 }
@@ -97,6 +97,7 @@ in
       pkgs.mono-gateway-fmc
       pkgs.mono-gateway-dpa-app
       pkgs.mono-gateway-cmm
+      pkgs.mono-gateway-ehash-stats
     ];
   };
 }
@@ -47,11 +47,16 @@ stdenv.mkDerivation {
   # No configure step
   dontConfigure = true;
 
+  # --wrap=fmc_compile: reuse the model compiled on an earlier boot from
+  # /var/cache/fmc while the XML inputs are unchanged (fmc 02-model-cache.patch)
+  # --wrap=fmc_execute and the FM_PCD_* wraps: send the table keys of the
+  # model in FM_IOC_PCD_BATCH ioctls (fmc 04-pcd-batch-keys.patch, fmlib
+  # 03-pcd-batch.patch)
   buildPhase = ''
     runHook preBuild
     make CC="${stdenv.cc.targetPrefix}cc" \
       CFLAGS="$NIX_CFLAGS_COMPILE" \
-      LDFLAGS="-L${mono-gateway-fmc}/lib -L${mono-gateway-fmlib}/lib -L${mono-gateway-libcli}/lib -Wl,--as-needed -lfmc -lfm-arm -lstdc++ -lxml2 -lpthread -lcli"
+      LDFLAGS="-L${mono-gateway-fmc}/lib -L${mono-gateway-fmlib}/lib -L${mono-gateway-libcli}/lib -Wl,--as-needed -Wl,--wrap=fmc_compile -Wl,--wrap=fmc_execute -Wl,--wrap=FM_PCD_HashTableAddKey,--wrap=FM_PCD_MatchTableAddKey,--wrap=FM_PCD_Close -lfmc -lfm-arm -lstdc++ -lxml2 -lpthread -lcli"
     runHook postBuild
   '';
 
@@ -0,0 +1,26 @@
+{ lib, stdenv }:
+
+stdenv.mkDerivation {
+  pname = "ehash-sim";
+  version = "1.0";
+
+  src = lib.fileset.toSource {
+    root = ./.;
+    fileset = lib.fileset.unions [
+      ./ehash-sim.c
+      ./Makefile
+    ];
+  };
+
+  makeFlags = [
+    "CC=${stdenv.cc.targetPrefix}cc"
+    "PREFIX=$(out)"
+  ];
+
+  meta = {
+    description = "Host-side simulator for the FMan enhanced external hash tables";
+    mainProgram = "ehash-sim";
+    platforms = lib.platforms.linux;
+    license = lib.licenses.gpl2Plus;
+  };
+}
@@ -0,0 +1,1114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * FMan enhanced external hash table simulator
+ *
+ * Replays conntrack traces (or random flows) against a host-side model of
+ * the tables built by ExternalHashTableSet() / ExternalHashTableAddKey() /
+ * ExternalHashTableDeleteKey() in sdk_fman/Peripherals/FM/Pcd/fm_ehash.c,
+ * so hash mask, hash shift and the cumulative entry format can be
+ * evaluated without LS1046A hardware.
+ *
+ * Model:
+ *   - Bucket index: CRC64 (ECMA-182, reflected, as in the SDK crc64.h)
+ *     of the key, shifted right by (6 - hashshift) bytes and masked with
+ *     hashmask, as get_indexed_hash_bucket() in fm_cc.c.
+ *   - A bucket holds either one table entry or a chain of 256 byte
+ *     cumulative nodes, each with as many key slots as fit (patch 010).
+ *     Keys go into the first node with a free slot, a new node is added
+ *     at the head of the chain when all are full.
+ *   - Deletes follow ExternalHashTableDeleteKey(): the last slot of a node is
+ *     dropped in place, any other slot rebuilds the node, nodes left with
+ *     one key are unlinked or collapsed back into a plain entry.
+ *   - With -C the NO_CUMULATIVE_ENTRY build is modelled instead: a plain
+ *     singly linked chain of table entries, new entries at the head.
+ *
+ * Probe depth is the number of 256 byte blocks the uCode reads to
+ * resolve a key: cumulative nodes scanned plus the table entry. Insert
+ * and delete cost is counted in nodes read, node allocations, node frees
+ * and bytes copied. Every delete also costs one FMan HC sync in the
+ * kernel, which is not counted here.
+ *
+ * Trace input is the output of "conntrack -L" or "conntrack -E" (with or
+ * without -o timestamp). [NEW] lines and lines without an event tag add
+ * flows, [DESTROY] lines delete them, [UPDATE] lines are ignored. Like
+ * CMM, every conntrack is offloaded in both directions unless -1 is given.
+ *
+ * Copyright 2026 Mono Technologies Inc.
+ * Author: Tomaz Zaman <tomaz@mono.si>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+/* from fm_ehash.h */
+#define MAX_KEY_LEN			56
+#define EN_EHASH_ENTRY_ALIGN		256
+#define EN_CUMULATIVE_NODE_MAX_SIZE	256
+#define EN_CU_HASH_TABLE_ENTRY_ADDR_SIZE 8
+#define EN_CU_FIXED_ELEMENTS_SIZE	12
+
+/*
+ * Allocation sizes on arm64: struct en_exthash_tbl_entry and
+ * struct en_cumulative_tbl_entry followed by the entry pool tag
+ * (patches 008 and 012), rounded up to EN_EHASH_ENTRY_ALIGN.
+ */
+#define EHASH_TBL_ENTRY_SIZE		(320 + (4 * 8))
+#define EHASH_CU_ENTRY_SIZE		(EN_CUMULATIVE_NODE_MAX_SIZE + (2 * 8))
+#define EHASH_POOL_TAG_SIZE		32
+#define EHASH_BUCKET_SIZE		8
+
+#define EHASH_SLOT_SIZE(size)						\
+	((((size) + EHASH_POOL_TAG_SIZE) + (EN_EHASH_ENTRY_ALIGN - 1)) &	\
+	 ~(EN_EHASH_ENTRY_ALIGN - 1))
+
+#define SIM_CU_MAX_SLOTS		32
+#define SIM_MAX_TABLES			16
+#define MAX_HIST_SIZE			15
+
+#define CRC64_ECMA_182			0xC96C5795D7870F42ULL
+#define CRC64_DEFAULT_INITVAL		0xFFFFFFFFFFFFFFFFULL
+
+/* table types, fm_eh_types.h */
+enum {
+	IPV4_UDP_TABLE,
+	IPV4_TCP_TABLE,
+	IPV6_UDP_TABLE,
+	IPV6_TCP_TABLE,
+	ESP_IPV4_TABLE,
+	ESP_IPV6_TABLE,
+	IPV4_MULTICAST_TABLE,
+	IPV6_MULTICAST_TABLE,
+	PPPOE_RELAY_TABLE,
+	ETHERNET_TABLE,
+	IPV4_3TUPLE_UDP_TABLE,
+	IPV4_3TUPLE_TCP_TABLE,
+	IPV6_3TUPLE_UDP_TABLE,
+	IPV6_3TUPLE_TCP_TABLE,
+	IPV4_REASSM_TABLE,
+	IPV6_REASSM_TABLE,
+	MAX_MATCH_TABLES
+};
+
+/*
+ * Key layouts, one character per field:
+ *   P port id (1)          S/D source/destination address (4 or 16)
+ *   R IP protocol (1)      s/d source/destination port (2)
+ *   I ESP SPI (4)          M/m source/destination MAC (6)
+ *   N PPPoE session (2)    E ethertype (2)
+ *   F fragment id (2 for IPv4, 4 for IPv6)
+ * Fields a conntrack does not carry (SPI, MACs, session, fragment id)
+ * are derived from its ports and addresses. Use -k when the PCD
+ * (cdx_pcd.xml) of the target build extracts a different key size.
+ */
+struct sim_type {
+	const char *name;
+	int family;		/* 4, 6 or 0 for either */
+	int proto;		/* IP protocol, 0 for any */
+	const char *fields;
+};
+
+static const struct sim_type sim_types[MAX_MATCH_TABLES] = {
+	[IPV4_UDP_TABLE]	= { "ipv4_udp", 4, 17, "PSDRsd" },
+	[IPV4_TCP_TABLE]	= { "ipv4_tcp", 4, 6, "PSDRsd" },
+	[IPV6_UDP_TABLE]	= { "ipv6_udp", 6, 17, "PSDRsd" },
+	[IPV6_TCP_TABLE]	= { "ipv6_tcp", 6, 6, "PSDRsd" },
+	[ESP_IPV4_TABLE]	= { "esp_ipv4", 4, 50, "PDRI" },
+	[ESP_IPV6_TABLE]	= { "esp_ipv6", 6, 50, "PDRI" },
+	[IPV4_MULTICAST_TABLE]	= { "ipv4_multicast", 4, 0, "PSD" },
+	[IPV6_MULTICAST_TABLE]	= { "ipv6_multicast", 6, 0, "PSD" },
+	[PPPOE_RELAY_TABLE]	= { "pppoe_relay", 0, 0, "PMN" },
+	[ETHERNET_TABLE]	= { "ethernet", 0, 0, "PmME" },
+	[IPV4_3TUPLE_UDP_TABLE]	= { "ipv4_3tuple_udp", 4, 17, "PDRd" },
+	[IPV4_3TUPLE_TCP_TABLE]	= { "ipv4_3tuple_tcp", 4, 6, "PDRd" },
+	[IPV6_3TUPLE_UDP_TABLE]	= { "ipv6_3tuple_udp", 6, 17, "PDRd" },
+	[IPV6_3TUPLE_TCP_TABLE]	= { "ipv6_3tuple_tcp", 6, 6, "PDRd" },
+	[IPV4_REASSM_TABLE]	= { "ipv4_reassm", 4, 0, "SDFR" },
+	[IPV6_REASSM_TABLE]	= { "ipv6_reassm", 6, 0, "SDF" },
+};
+
+struct sim_flow {
+	int family;
+	uint8_t proto;
+	uint8_t saddr[16];
+	uint8_t daddr[16];
+	uint16_t sport;
+	uint16_t dport;
+};
+
+struct sim_entry {
+	uint8_t key[MAX_KEY_LEN];
+	uint32_t live_pos;	/* index in sim_table.live */
+};
+
+struct sim_node {
+	struct sim_node *next;
+	struct sim_node *prev;
+	uint32_t num;
+	uint32_t slots;
+	uint32_t entry[SIM_CU_MAX_SLOTS];
+};
+
+struct sim_bucket {
+	int32_t direct;		/* entry of a single key bucket, -1 if none */
+	struct sim_node *chain;	/* cumulative nodes, or plain chain with -C */
+};
+
+struct sim_cost {
+	uint64_t ops;
+	uint64_t failed;	/* duplicate key on add, no match on delete */
+	uint64_t nodes_read;
+	uint64_t max_nodes_read;
+	uint64_t allocs;
+	uint64_t frees;
+	uint64_t bytes_copied;
+};
+
+struct sim_table {
+	int type;
+	uint32_t key_size;
+	uint32_t key_align;	/* key slot size in cumulative nodes */
+	uint32_t hashmask;
+	uint32_t hashshift;
+	struct sim_bucket *buckets;
+
+	struct sim_entry *entries;
+	uint32_t num_entries;	/* allocated in entries[] */
+	uint32_t *free_ids;
+	uint32_t num_free;
+	uint32_t *live;		/* ids of the keys in the table */
+	uint32_t num_live;
+	uint32_t peak_live;
+
+	uint32_t num_nodes;
+	uint32_t peak_nodes;
+	uint64_t skipped;	/* flows not matching the table type */
+
+	struct sim_cost add;
+	struct sim_cost del;
+};
+
+static struct sim_table sim_tables[SIM_MAX_TABLES];
+static uint32_t num_sim_tables;
+static int no_cumulative;
+static uint8_t port_id;
+static uint64_t crc64_table[256];
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static void crc64_init_table(void)
+{
+	uint64_t crc;
+	int ii, jj;
+
+	for (ii = 0; ii < 256; ii++) {
+		crc = ii;
+		for (jj = 0; jj < 8; jj++)
+			crc = (crc & 1) ? ((crc >> 1) ^ CRC64_ECMA_182) : (crc >> 1);
+		crc64_table[ii] = crc;
+	}
+}
+
+static uint32_t sim_hash_bucket(struct sim_table *tbl, const uint8_t *key)
+{
+	uint64_t crc64;
+	uint32_t ii;
+
+	crc64 = CRC64_DEFAULT_INITVAL;
+	for (ii = 0; ii < tbl->key_size; ii++)
+		crc64 = crc64_table[(crc64 ^ key[ii]) & 0xff] ^ (crc64 >> 8);
+	crc64 >>= ((6 - tbl->hashshift) << 3);
+	return ((uint16_t)crc64 & tbl->hashmask);
+}
+
+static uint64_t rng_next(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return rng_state;
+}
+
+static void *xcalloc(size_t num, size_t size)
+{
+	void *ptr;
+
+	ptr = calloc(num, size);
+	if (!ptr) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	return ptr;
+}
+
+static void *xrealloc(void *ptr, size_t size)
+{
+	ptr = realloc(ptr, size);
+	if (!ptr) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	return ptr;
+}
+
+static uint32_t sim_key_size(const struct sim_type *type)
+{
+	const char *field;
+	uint32_t size;
+	int addr_len;
+
+	addr_len = (type->family == 6) ? 16 : 4;
+	size = 0;
+	for (field = type->fields; *field; field++) {
+		switch (*field) {
+		case 'P':
+		case 'R':
+			size += 1;
+			break;
+		case 'S':
+		case 'D':
+			size += addr_len;
+			break;
+		case 's':
+		case 'd':
+		case 'N':
+		case 'E':
+			size += 2;
+			break;
+		case 'I':
+			size += 4;
+			break;
+		case 'M':
+		case 'm':
+			size += 6;
+			break;
+		case 'F':
+			size += (type->family == 6) ? 4 : 2;
+			break;
+		}
+	}
+	return size;
+}
+
+static void put16(uint8_t **ptr, uint16_t val)
+{
+	(*ptr)[0] = val >> 8;
+	(*ptr)[1] = val & 0xff;
+	*ptr += 2;
+}
+
+static void sim_build_key(struct sim_table *tbl, const struct sim_flow *flow,
+		uint8_t *key)
+{
+	const struct sim_type *type;
+	const char *field;
+	uint8_t *ptr;
+	int addr_len;
+
+	type = &sim_types[tbl->type];
+	addr_len = (flow->family == 6) ? 16 : 4;
+	memset(key, 0, MAX_KEY_LEN);
+	ptr = key;
+	for (field = type->fields; *field; field++) {
+		switch (*field) {
+		case 'P':
+			*ptr++ = port_id;
+			break;
+		case 'R':
+			*ptr++ = flow->proto;
+			break;
+		case 'S':
+			memcpy(ptr, flow->saddr, addr_len);
+			ptr += addr_len;
+			break;
+		case 'D':
+			memcpy(ptr, flow->daddr, addr_len);
+			ptr += addr_len;
+			break;
+		case 's':
+		case 'N':
+			put16(&ptr, flow->sport);
+			break;
+		case 'd':
+		case 'E':
+			put16(&ptr, flow->dport);
+			break;
+		case 'I':
+		case 'F':
+			if ((*field == 'F') && (flow->family == 4)) {
+				put16(&ptr, flow->sport ^ flow->dport);
+				break;
+			}
+			put16(&ptr, flow->sport);
+			put16(&ptr, flow->dport);
+			break;
+		case 'M':
+			ptr[0] = 0x02;
+			ptr[1] = 0x00;
+			memcpy(&ptr[2], &flow->saddr[addr_len - 4], 4);
+			ptr += 6;
+			break;
+		case 'm':
+			ptr[0] = 0x02;
+			ptr[1] = 0x00;
+			memcpy(&ptr[2], &flow->daddr[addr_len - 4], 4);
+			ptr += 6;
+			break;
+		}
+		/* keys may be cut short with -k */
+		if ((uint32_t)(ptr - key) >= tbl->key_size)
+			break;
+	}
+	if ((uint32_t)(ptr - key) > tbl->key_size)
+		memset(&key[tbl->key_size], 0, (ptr - key) - tbl->key_size);
+}
+
+static int sim_flow_matches(struct sim_table *tbl, const struct sim_flow *flow)
+{
+	const struct sim_type *type;
+
+	type = &sim_types[tbl->type];
+	if (type->family && (type->family != flow->family))
+		return 0;
+	if (type->proto && (type->proto != flow->proto))
+		return 0;
+	return 1;
+}
+
+/* en_cu_capacity() */
+static uint32_t sim_cu_capacity(uint32_t key_size)
+{
+	return ((EN_CUMULATIVE_NODE_MAX_SIZE - EN_CU_FIXED_ELEMENTS_SIZE - 1) /
+			(key_size + EN_CU_HASH_TABLE_ENTRY_ADDR_SIZE));
+}
+
+static void sim_table_init(struct sim_table *tbl, int type, uint32_t key_size,
+		uint32_t hashmask, uint32_t hashshift)
+{
+	uint32_t ii;
+
+	memset(tbl, 0, sizeof(struct sim_table));
+	tbl->type = type;
+	tbl->key_size = key_size ? key_size : sim_key_size(&sim_types[type]);
+	if (tbl->key_size > MAX_KEY_LEN)
+		tbl->key_size = MAX_KEY_LEN;
+	/* same rounding as ExternalHashTableAddKey() */
+	if (tbl->key_size <= 2)
+		tbl->key_align = tbl->key_size;
+	else if (tbl->key_size <= 4)
+		tbl->key_align = 4;
+	else
+		tbl->key_align = ((tbl->key_size + 7) & 0x38);
+	tbl->hashmask = hashmask;
+	tbl->hashshift = hashshift;
+	tbl->buckets = xcalloc(hashmask + 1, sizeof(struct sim_bucket));
+	for (ii = 0; ii <= hashmask; ii++)
+		tbl->buckets[ii].direct = -1;
+}
+
+static uint32_t sim_entry_alloc(struct sim_table *tbl, const uint8_t *key)
+{
+	uint32_t id;
+
+	if (tbl->num_free) {
+		id = tbl->free_ids[--tbl->num_free];
+	} else {
+		id = tbl->num_entries++;
+		tbl->entries = xrealloc(tbl->entries,
+				tbl->num_entries * sizeof(struct sim_entry));
+		tbl->free_ids = xrealloc(tbl->free_ids,
+				tbl->num_entries * sizeof(uint32_t));
+		tbl->live = xrealloc(tbl->live,
+				tbl->num_entries * sizeof(uint32_t));
+	}
+	memcpy(tbl->entries[id].key, key, MAX_KEY_LEN);
+	tbl->entries[id].live_pos = tbl->num_live;
+	tbl->live[tbl->num_live++] = id;
+	if (tbl->num_live > tbl->peak_live)
+		tbl->peak_live = tbl->num_live;
+	return id;
+}
+
+static void sim_entry_free(struct sim_table *tbl, uint32_t id)
+{
+	uint32_t pos, last;
+
+	pos = tbl->entries[id].live_pos;
+	last = tbl->live[--tbl->num_live];
+	tbl->live[pos] = last;
+	tbl->entries[last].live_pos = pos;
+	tbl->free_ids[tbl->num_free++] = id;
+}
+
+static struct sim_node *sim_node_alloc(struct sim_table *tbl,
+		struct sim_cost *cost)
+{
+	struct sim_node *node;
+
+	node = xcalloc(1, sizeof(struct sim_node));
+	node->slots = no_cumulative ? 1 : sim_cu_capacity(tbl->key_align);
+	if (node->slots > SIM_CU_MAX_SLOTS)
+		node->slots = SIM_CU_MAX_SLOTS;
+	if (++tbl->num_nodes > tbl->peak_nodes)
+		tbl->peak_nodes = tbl->num_nodes;
+	cost->allocs++;
+	return node;
+}
+
+static void sim_node_free(struct sim_table *tbl, struct sim_node *node,
+		struct sim_cost *cost)
+{
+	tbl->num_nodes--;
+	cost->frees++;
+	free(node);
+}
+
+static int sim_key_equal(struct sim_table *tbl, uint32_t id, const uint8_t *key)
+{
+	return !memcmp(tbl->entries[id].key, key, tbl->key_size);
+}
+
+/* bytes written to fill a key slot, en_cu_fill_slot() */
+static uint32_t sim_slot_bytes(struct sim_table *tbl)
+{
+	return (tbl->key_align + EN_CU_HASH_TABLE_ENTRY_ADDR_SIZE);
+}
+
+static void sim_account(struct sim_cost *cost, uint64_t nodes_read)
+{
+	cost->ops++;
+	cost->nodes_read += nodes_read;
+	if (nodes_read > cost->max_nodes_read)
+		cost->max_nodes_read = nodes_read;
+}
+
+/* find_entry_in_bucket(), returns the node holding the key and its slot */
+static struct sim_node *sim_find(struct sim_table *tbl,
+		struct sim_bucket *bucket, const uint8_t *key, uint32_t *slot,
+		uint64_t *nodes_read)
+{
+	struct sim_node *node;
+	uint32_t ii;
+
+	*nodes_read = 0;
+	for (node = bucket->chain; node; node = node->next) {
+		(*nodes_read)++;
+		for (ii = 0; ii < node->num; ii++) {
+			if (sim_key_equal(tbl, node->entry[ii], key)) {
+				*slot = ii;
+				return node;
+			}
+		}
+	}
+	return NULL;
+}
+
+static int sim_add(struct sim_table *tbl, const uint8_t *key)
+{
+	struct sim_bucket *bucket;
+	struct sim_node *node;
+	uint64_t nodes_read;
+	uint32_t slot, id;
+
+	nodes_read = 0;
+	bucket = &tbl->buckets[sim_hash_bucket(tbl, key)];
+	if (bucket->direct >= 0) {
+		if (sim_key_equal(tbl, bucket->direct, key)) {
+			sim_account(&tbl->add, 1);
+			tbl->add.failed++;
+			return -1;
+		}
+	} else if (sim_find(tbl, bucket, key, &slot, &nodes_read)) {
+		sim_account(&tbl->add, nodes_read);
+		tbl->add.failed++;
+		return -1;
+	}
+	id = sim_entry_alloc(tbl, key);
+	if (no_cumulative) {
+		/*
+		 * new entry at the head of the chain, the links are the table
+		 * entries themselves and cost no allocation of their own
+		 */
+		node = sim_node_alloc(tbl, &tbl->add);
+		tbl->add.allocs--;
+		node->entry[0] = id;
+		node->num = 1;
+		node->next = bucket->chain;
+		if (bucket->chain)
+			bucket->chain->prev = node;
+		bucket->chain = node;
+		sim_account(&tbl->add, nodes_read);
+		return 0;
+	}
+	if ((bucket->direct < 0) && !bucket->chain) {
+		bucket->direct = id;
+		sim_account(&tbl->add, 0);
+		return 0;
+	}
+	if (bucket->direct >= 0) {
+		/* second key, both go into a new cumulative node */
+		node = sim_node_alloc(tbl, &tbl->add);
+		node->entry[0] = id;
+		node->entry[1] = bucket->direct;
+		node->num = 2;
+		bucket->direct = -1;
+		bucket->chain = node;
+		tbl->add.bytes_copied += 2 * sim_slot_bytes(tbl);
+		sim_account(&tbl->add, 1);
+		return 0;
+	}
+	/* first node with a free slot */
+	for (node = bucket->chain; node; node = node->next) {
+		if (node->num < node->slots)
+			break;
+	}
+	if (node) {
+		node->entry[node->num++] = id;
+	} else {
+		node = sim_node_alloc(tbl, &tbl->add);
+		node->entry[0] = id;
+		node->num = 1;
+		node->next = bucket->chain;
+		bucket->chain->prev = node;
+		bucket->chain = node;
+	}
+	tbl->add.bytes_copied += sim_slot_bytes(tbl);
+	sim_account(&tbl->add, nodes_read);
+	return 0;
+}
+
+static void sim_unlink(struct sim_bucket *bucket, struct sim_node *node)
+{
+	if (node->prev)
+		node->prev->next = node->next;
+	else
+		bucket->chain = node->next;
+	if (node->next)
+		node->next->prev = node->prev;
+}
+
+static int sim_delete(struct sim_table *tbl, const uint8_t *key)
+{
+	struct sim_bucket *bucket;
+	struct sim_node *node, *other;
+	uint64_t nodes_read;
+	uint32_t slot, id, jj;
+	int neighbour;
+
+	bucket = &tbl->buckets[sim_hash_bucket(tbl, key)];
+	if (bucket->direct >= 0) {
+		sim_account(&tbl->del, 1);
+		if (!sim_key_equal(tbl, bucket->direct, key)) {
+			tbl->del.failed++;
+			return -1;
+		}
+		sim_entry_free(tbl, bucket->direct);
+		bucket->direct = -1;
+		return 0;
+	}
+	node = sim_find(tbl, bucket, key, &slot, &nodes_read);
+	sim_account(&tbl->del, nodes_read);
+	if (!node) {
+		tbl->del.failed++;
+		return -1;
+	}
+	id = node->entry[slot];
+	sim_entry_free(tbl, id);
+	if (no_cumulative) {
+		/* the entry is retired by the caller, as for a plain entry */
+		sim_unlink(bucket, node);
+		sim_node_free(tbl, node, &tbl->del);
+		tbl->del.frees--;
+		return 0;
+	}
+	neighbour = (node->prev || node->next);
+	if ((node->num > 2) || ((node->num == 2) && neighbour)) {
+		if (slot != (node->num - 1)) {
+			/* rebuild the node without the slot */
+			tbl->del.bytes_copied += (node->num - 1) *
+				sim_slot_bytes(tbl);
+			tbl->del.allocs++;
+			tbl->del.frees++;
+			for (jj = slot; jj < (node->num - 1); jj++)
+				node->entry[jj] = node->entry[jj + 1];
+		}
+		node->num--;
+		return 0;
+	}
+	if ((node->num == 2) && !neighbour) {
+		/* back to a single entry bucket */
+		bucket->direct = node->entry[slot ? 0 : 1];
+		bucket->chain = NULL;
+		sim_node_free(tbl, node, &tbl->del);
+		return 0;
+	}
+	/* last key of the node */
+	other = node->next ? node->next : node->prev;
+	sim_unlink(bucket, node);
+	sim_node_free(tbl, node, &tbl->del);
+	if (other && (other->num == 1) && !other->next && !other->prev) {
+		bucket->direct = other->entry[0];
+		bucket->chain = NULL;
+		sim_node_free(tbl, other, &tbl->del);
+	}
+	return 0;
+}
+
+static void sim_flow_apply(const struct sim_flow *flow, int add)
+{
+	uint8_t key[MAX_KEY_LEN];
+	struct sim_table *tbl;
+	uint32_t ii;
+
+	for (ii = 0; ii < num_sim_tables; ii++) {
+		tbl = &sim_tables[ii];
+		if (!sim_flow_matches(tbl, flow)) {
+			tbl->skipped++;
+			continue;
+		}
+		sim_build_key(tbl, flow, key);
+		if (add)
+			sim_add(tbl, key);
+		else
+			sim_delete(tbl, key);
+	}
+}
+
+static void sim_flow_reverse(const struct sim_flow *flow, struct sim_flow *rev)
+{
+	*rev = *flow;
+	memcpy(rev->saddr, flow->daddr, sizeof(rev->saddr));
+	memcpy(rev->daddr, flow->saddr, sizeof(rev->daddr));
+	rev->sport = flow->dport;
+	rev->dport = flow->sport;
+}
+
+static void sim_conntrack_apply(const struct sim_flow *flow, int add,
+		int both_dirs)
+{
+	struct sim_flow rev;
+
+	sim_flow_apply(flow, add);
+	if (both_dirs) {
+		sim_flow_reverse(flow, &rev);
+		sim_flow_apply(&rev, add);
+	}
+}
+
+static int parse_addr(const char *str, struct sim_flow *flow, uint8_t *addr)
+{
+	char buf[64];
+	size_t len;
+
+	len = strcspn(str, " \t\n");
+	if (len >= sizeof(buf))
+		return -1;
+	memcpy(buf, str, len);
+	buf[len] = '\0';
+	if (inet_pton(AF_INET, buf, addr) == 1) {
+		flow->family = 4;
+		return 0;
+	}
+	if (inet_pton(AF_INET6, buf, addr) == 1) {
+		flow->family = 6;
+		return 0;
+	}
+	return -1;
+}
+
+/* returns 1 for add, 0 for delete, -1 to skip the line */
+static int parse_conntrack(const char *line, struct sim_flow *flow)
+{
+	const char *ptr;
+	char name[16];
+	unsigned int proto;
+	int add;
+
+	memset(flow, 0, sizeof(struct sim_flow));
+	add = 1;
+	ptr = line;
+	/* optional "[1234567.123456]" timestamp and event tag */
+	while (*ptr == ' ' || *ptr == '\t' || *ptr == '[') {
+		if (*ptr != '[') {
+			ptr++;
+			continue;
+		}
+		if (!strncmp(ptr, "[NEW]", 5))
+			add = 1;
+		else if (!strncmp(ptr, "[DESTROY]", 9))
+			add = 0;
+		else if (!strncmp(ptr, "[UPDATE]", 8))
+			return -1;
+		ptr = strchr(ptr, ']');
+		if (!ptr)
+			return -1;
+		ptr++;
+	}
+	if (sscanf(ptr, "%15s %u", name, &proto) != 2)
+		return -1;
+	flow->proto = proto;
+	ptr = strstr(line, "src=");
+	if (!ptr || parse_addr(ptr + 4, flow, flow->saddr))
+		return -1;
+	ptr = strstr(line, "dst=");
+	if (!ptr || parse_addr(ptr + 4, flow, flow->daddr))
+		return -1;
+	ptr = strstr(line, "sport=");
+	if (ptr)
+		flow->sport = strtoul(ptr + 6, NULL, 10);
+	ptr = strstr(line, "dport=");
+	if (ptr)
+		flow->dport = strtoul(ptr + 6, NULL, 10);
+	/* ESP has no ports, conntrack shows neither */
+	return add;
+}
+
+static int replay_trace(FILE *file, int both_dirs, uint64_t *lines,
+		uint64_t *bad)
+{
+	struct sim_flow flow;
+	char line[1024];
+	int add;
+
+	while (fgets(line, sizeof(line), file)) {
+		(*lines)++;
+		add = parse_conntrack(line, &flow);
+		if (add < 0) {
+			(*bad)++;
+			continue;
+		}
+		sim_conntrack_apply(&flow, add, both_dirs);
+	}
+	return ferror(file) ? -1 : 0;
+}
+
+static void random_flow(struct sim_flow *flow, int family, uint8_t proto)
+{
+	uint64_t rnd;
+
+	memset(flow, 0, sizeof(struct sim_flow));
+	flow->family = family;
+	flow->proto = proto;
+	rnd = rng_next();
+	if (family == 4) {
+		/* LAN clients talking to the internet */
+		flow->saddr[0] = 192;
+		flow->saddr[1] = 168;
+		flow->saddr[2] = (rnd >> 8) & 0x3;
+		flow->saddr[3] = rnd & 0xff;
+		rnd = rng_next();
+		memcpy(flow->daddr, &rnd, 4);
+	} else {
+		flow->saddr[0] = 0x20;
+		flow->saddr[1] = 0x01;
+		flow->saddr[2] = 0x0d;
+		flow->saddr[3] = 0xb8;
+		memcpy(&flow->saddr[8], &rnd, 8);
+		rnd = rng_next();
+		memcpy(flow->daddr, &rnd, 8);
+		rnd = rng_next();
+		memcpy(&flow->daddr[8], &rnd, 8);
+	}
+	rnd = rng_next();
+	flow->sport = 1024 + (rnd % 64512);
+	flow->dport = (rnd >> 32) & 1 ? 443 : (rnd >> 16) & 0xffff;
+}
+
+/*
+ * Inserts num random conntracks, then replaces a random live one with a
+ * new one churn times. Deleted conntracks are looked up again from the
+ * key kept in the table model, so no flow list is needed.
+ */
+static void random_replay(uint64_t num, uint64_t churn, int both_dirs)
+{
+	struct sim_flow *flows;
+	uint64_t ii, pick;
+	int family;
+	uint8_t proto;
+
+	if (!num)
+		return;
+	flows = xcalloc(num, sizeof(struct sim_flow));
+	for (ii = 0; ii < num; ii++) {
+		family = (rng_next() & 3) ? 4 : 6;
+		proto = (rng_next() & 1) ? 6 : 17;
+		random_flow(&flows[ii], family, proto);
+		sim_conntrack_apply(&flows[ii], 1, both_dirs);
+	}
+	for (ii = 0; ii < churn; ii++) {
+		pick = rng_next() % num;
+		sim_conntrack_apply(&flows[pick], 0, both_dirs);
+		random_flow(&flows[pick], flows[pick].family, flows[pick].proto);
+		sim_conntrack_apply(&flows[pick], 1, both_dirs);
+	}
+	free(flows);
+}
+
+static void print_cost(const char *name, const struct sim_cost *cost)
+{
+	double ops;
+
+	ops = cost->ops ? (double)cost->ops : 1.0;
+	printf("  %-6s ops %llu, failed %llu, nodes read avg %.2f max %llu, "
+		"allocs/op %.3f, node frees/op %.3f, bytes copied/op %.1f\n",
+		name, (unsigned long long)cost->ops,
+		(unsigned long long)cost->failed, cost->nodes_read / ops,
+		(unsigned long long)cost->max_nodes_read, cost->allocs / ops,
+		cost->frees / ops, cost->bytes_copied / ops);
+}
+
+static void sim_table_report(struct sim_table *tbl)
+{
+	struct sim_bucket *bucket;
+	struct sim_node *node;
+	uint32_t histo[MAX_HIST_SIZE + 2];
+	uint32_t depth_histo[MAX_HIST_SIZE + 2];
+	uint64_t hit_depth, max_depth, miss_depth, used, slots, keys, cu_keys;
+	uint64_t bucket_bytes, entry_bytes, node_bytes;
+	uint32_t ii, jj, depth, bucket_keys;
+
+	memset(histo, 0, sizeof(histo));
+	memset(depth_histo, 0, sizeof(depth_histo));
+	hit_depth = 0;
+	max_depth = 0;
+	miss_depth = 0;
+	used = 0;
+	slots = 0;
+	keys = 0;
+	cu_keys = 0;
+	for (ii = 0; ii <= tbl->hashmask; ii++) {
+		bucket = &tbl->buckets[ii];
+		bucket_keys = 0;
+		depth = 0;
+		if (bucket->direct >= 0) {
+			bucket_keys = 1;
+			depth = 1;
+			hit_depth += 1;
+		}
+		for (node = bucket->chain; node; node = node->next) {
+			depth++;
+			slots += node->slots;
+			bucket_keys += node->num;
+			cu_keys += node->num;
+			/* scanned nodes plus the table entry behind the match */
+			for (jj = 0; jj < node->num; jj++)
+				hit_depth += no_cumulative ? depth : (depth + 1);
+		}
+		if (bucket_keys) {
+			used++;
+			miss_depth += depth;
+			keys += bucket_keys;
+			if (!no_cumulative && bucket->chain)
+				depth++;
+			if (depth > max_depth)
+				max_depth = depth;
+		}
+		histo[(bucket_keys > MAX_HIST_SIZE) ? (MAX_HIST_SIZE + 1) :
+			bucket_keys]++;
+		if (bucket_keys)
+			depth_histo[(depth > MAX_HIST_SIZE) ? (MAX_HIST_SIZE + 1) :
+				depth]++;
+	}
+	bucket_bytes = (uint64_t)(tbl->hashmask + 1) * EHASH_BUCKET_SIZE;
+	entry_bytes = (uint64_t)tbl->peak_live *
+		EHASH_SLOT_SIZE(EHASH_TBL_ENTRY_SIZE);
+	node_bytes = no_cumulative ? 0 : ((uint64_t)tbl->peak_nodes *
+		EHASH_SLOT_SIZE(EHASH_CU_ENTRY_SIZE));
+
+	printf("table %s: key size %u (slot %u), buckets %u, shift %u, %s\n",
+		sim_types[tbl->type].name, tbl->key_size, tbl->key_align,
+		tbl->hashmask + 1, tbl->hashshift,
+		no_cumulative ? "plain chains" : "cumulative nodes");
+	printf("  keys %llu (peak %u), buckets used %llu, load %.3f, "
+		"flows skipped %llu\n", (unsigned long long)keys,
+		tbl->peak_live, (unsigned long long)used,
+		(double)keys / (tbl->hashmask + 1),
+		(unsigned long long)tbl->skipped);
+	printf("  probe depth: hit avg %.3f, max %llu, miss avg %.3f\n",
+		keys ? (double)hit_depth / keys : 0.0,
+		(unsigned long long)max_depth,
+		(double)miss_depth / (tbl->hashmask + 1));
+	if (!no_cumulative)
+		printf("  cumulative nodes %u (peak %u), key slots used %llu of %llu\n",
+			tbl->num_nodes, tbl->peak_nodes,
+			(unsigned long long)cu_keys, (unsigned long long)slots);
+	printf("  memory at peak: buckets %llu, entries %llu, nodes %llu, "
+		"total %llu bytes\n", (unsigned long long)bucket_bytes,
+		(unsigned long long)entry_bytes, (unsigned long long)node_bytes,
+		(unsigned long long)(bucket_bytes + entry_bytes + node_bytes));
+	print_cost("add", &tbl->add);
+	print_cost("delete", &tbl->del);
+	printf("  num keys\tnum buckets\tprobe depth\tnum buckets\n");
+	for (ii = 0; ii <= MAX_HIST_SIZE; ii++)
+		printf("  %u\t\t%u\t\t%u\t\t%u\n", ii, histo[ii], ii,
+			depth_histo[ii]);
+	printf("  >%u\t\t%u\t\t>%u\t\t%u\n", MAX_HIST_SIZE,
+		histo[MAX_HIST_SIZE + 1], MAX_HIST_SIZE,
+		depth_histo[MAX_HIST_SIZE + 1]);
+}
+
+static int parse_types(const char *arg, int *types, uint32_t *num)
+{
+	char buf[256], *name, *save;
+	int ii;
+
+	*num = 0;
+	if (!strcmp(arg, "all")) {
+		for (ii = 0; ii < MAX_MATCH_TABLES; ii++)
+			types[(*num)++] = ii;
+		return 0;
+	}
+	if (strlen(arg) >= sizeof(buf))
+		return -1;
+	strcpy(buf, arg);
+	for (name = strtok_r(buf, ",", &save); name;
+			name = strtok_r(NULL, ",", &save)) {
+		for (ii = 0; ii < MAX_MATCH_TABLES; ii++) {
+			if (!strcmp(name, sim_types[ii].name))
+				break;
+		}
+		if ((ii == MAX_MATCH_TABLES) || (*num >= SIM_MAX_TABLES)) {
+			fprintf(stderr, "unknown table type %s\n", name);
+			return -1;
+		}
+		types[(*num)++] = ii;
+	}
+	return 0;
+}
+
+static void usage(const char *prog)
+{
+	int ii;
+
+	fprintf(stderr,
+		"usage: %s [options] [trace ...]\n"
+		"Replays conntrack -L / -E output (\"-\" for stdin) against a model\n"
+		"of the FMan enhanced external hash tables.\n"
+		"  -t types   comma separated table types or \"all\"\n"
+		"             (default ipv4_udp,ipv4_tcp,ipv6_udp,ipv6_tcp)\n"
+		"  -m mask    hash result mask, 2^n - 1 up to 0xffff (default 0x3fff)\n"
+		"  -S shift   hash shift in bytes, 0 to 6 (default 0)\n"
+		"  -k size    key size in bytes, overrides the type's key layout\n"
+		"  -p id      port id placed in the keys (default 0)\n"
+		"  -C         plain entry chains (NO_CUMULATIVE_ENTRY build)\n"
+		"  -1         offload the original direction only\n"
+		"  -r num     insert num random conntracks\n"
+		"  -c num     then replace num random conntracks with new ones\n"
+		"  -s seed    random seed\n"
+		"table types:", prog);
+	for (ii = 0; ii < MAX_MATCH_TABLES; ii++)
+		fprintf(stderr, "%s%s", ii ? ", " : " ", sim_types[ii].name);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int types[SIM_MAX_TABLES];
+	uint32_t num_types, hashmask, hashshift, key_size, ii;
+	uint64_t num_random, churn, lines, bad;
+	int both_dirs, opt, ret;
+	FILE *file;
+
+	parse_types("ipv4_udp,ipv4_tcp,ipv6_udp,ipv6_tcp", types, &num_types);
+	hashmask = 0x3fff;
+	hashshift = 0;
+	key_size = 0;
+	both_dirs = 1;
+	num_random = 0;
+	churn = 0;
+	while ((opt = getopt(argc, argv, "t:m:S:k:p:C1r:c:s:h")) != -1) {
+		switch (opt) {
+		case 't':
+			if (parse_types(optarg, types, &num_types))
+				return 1;
+			break;
+		case 'm':
+			hashmask = strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			hashshift = strtoul(optarg, NULL, 0);
+			break;
+		case 'k':
+			key_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			port_id = strtoul(optarg, NULL, 0);
+			break;
+		case 'C':
+			no_cumulative = 1;
+			break;
+		case '1':
+			both_dirs = 0;
+			break;
+		case 'r':
+			num_random = strtoull(optarg, NULL, 0);
+			break;
+		case 'c':
+			churn = strtoull(optarg, NULL, 0);
+			break;
+		case 's':
+			rng_state = strtoull(optarg, NULL, 0);
+			if (!rng_state)
+				rng_state = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if (!hashmask || (hashmask > 0xffff) || (hashmask & (hashmask + 1))) {
+		fprintf(stderr, "hash mask must be 2^n - 1, up to 0xffff\n");
+		return 1;
+	}
+	if (hashshift > 6) {
+		fprintf(stderr, "hash shift must be 0 to 6\n");
+		return 1;
+	}
+	if (key_size > MAX_KEY_LEN) {
+		fprintf(stderr, "key size must be up to %d\n", MAX_KEY_LEN);
+		return 1;
+	}
+	if ((optind == argc) && !num_random) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	crc64_init_table();
+	num_sim_tables = num_types;
+	for (ii = 0; ii < num_types; ii++)
+		sim_table_init(&sim_tables[ii], types[ii], key_size, hashmask,
+				hashshift);
+
+	lines = 0;
+	bad = 0;
+	for (ii = optind; ii < (uint32_t)argc; ii++) {
+		if (!strcmp(argv[ii], "-")) {
+			file = stdin;
+		} else {
+			file = fopen(argv[ii], "r");
+			if (!file) {
+				fprintf(stderr, "%s: %s\n", argv[ii],
+					strerror(errno));
+				return 1;
+			}
+		}
+		ret = replay_trace(file, both_dirs, &lines, &bad);
+		if (file != stdin)
+			fclose(file);
+		if (ret) {
+			fprintf(stderr, "%s: read error\n", argv[ii]);
+			return 1;
+		}
+	}
+	random_replay(num_random, churn, both_dirs);
+
+	if (lines)
+		printf("trace lines %llu, ignored %llu\n",
+			(unsigned long long)lines, (unsigned long long)bad);
+	for (ii = 0; ii < num_sim_tables; ii++)
+		sim_table_report(&sim_tables[ii]);
+	return 0;
+}
@@ -0,0 +1,26 @@
+{ lib, stdenv }:
+
+stdenv.mkDerivation {
+  pname = "ehash-stats";
+  version = "1.0";
+
+  src = lib.fileset.toSource {
+    root = ./.;
+    fileset = lib.fileset.unions [
+      ./ehash-stats.c
+      ./Makefile
+    ];
+  };
+
+  makeFlags = [
+    "CC=${stdenv.cc.targetPrefix}cc"
+    "PREFIX=$(out)"
+  ];
+
+  meta = {
+    description = "Reader for the FMan external hash flow stats snapshot (/dev/fm_ehash_stats)";
+    mainProgram = "ehash-stats";
+    platforms = lib.platforms.linux;
+    license = lib.licenses.gpl2Plus;
+  };
+}
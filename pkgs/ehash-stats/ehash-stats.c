@@ -0,0 +1,436 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Reader for the FMan external hash stats snapshot
+ *
+ * Maps /dev/fm_ehash_stats (kernel patch 011) and prints the hit
+ * counters of the offloaded flows, either summed per table or one line
+ * per flow. While the device is open the kernel refreshes the snapshot
+ * every interval_ms; a copy is only used if the header sequence counter
+ * was even and unchanged across it, as with a seqcount.
+ *
+ * Flows are named by table (numbered in creation order), bucket index
+ * and key. The timestamp is the raw FMan timestamp of the last hit, idle
+ * the number of aging sweeps (kernel patch 014) the flow went unhit.
+ * With -p, the entry pool usage of each table (kernel patch 008) is
+ * printed instead.
+ *
+ * Copyright 2026 Mono Technologies Inc.
+ * Author: Tomaz Zaman <tomaz@mono.si>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+
+/* from fm_ehash.h, must match the kernel */
+#define MAX_KEY_LEN			56
+#define EN_EHASH_SNAPSHOT_VERSION	2
+#define EN_EHASH_SNAPSHOT_MAX_TABLES	64
+#define EN_EHASH_SNAPSHOT_POOL_OFFSET	64
+#define EN_EHASH_SNAPSHOT_REC_OFFSET	(EN_EHASH_SNAPSHOT_POOL_OFFSET + \
+		(EN_EHASH_SNAPSHOT_MAX_TABLES * sizeof(struct en_ehash_snapshot_pool)))
+#define STATS_VALID			(1 << 0)
+#define TIMESTAMP_VALID			(1 << 1)
+#define AGING_VALID			(1 << 2)
+
+struct en_ehash_snapshot_hdr {
+	uint32_t seq;
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t max_records;
+	uint32_t num_records;
+	uint32_t interval_ms;
+	uint64_t snap_time_ns;
+	uint32_t num_tables;
+	uint32_t rsvd;
+};
+
+struct en_ehash_pool_stats {
+	uint32_t size;
+	uint32_t in_use;
+	uint32_t high_watermark;
+	uint32_t fallback;
+	uint32_t failed;
+};
+
+struct en_ehash_snapshot_pool {
+	uint32_t table_type;
+	uint32_t rsvd;
+	struct en_ehash_pool_stats entries;
+	struct en_ehash_pool_stats cumulative;
+};
+
+struct en_ehash_snapshot_rec {
+	uint16_t table;
+	uint16_t idle;
+	uint32_t bucket;
+	uint64_t pkts;
+	uint64_t bytes;
+	uint32_t timestamp;
+	uint16_t flags;
+	uint8_t table_type;
+	uint8_t key_size;
+	uint8_t key[MAX_KEY_LEN];
+};
+
+#define SNAP_DEV		"/dev/fm_ehash_stats"
+#define SNAP_READ_TRIES		200
+#define SNAP_RETRY_US		10000
+
+/* table types, fm_eh_types.h */
+static const char *type_names[] = {
+	"ipv4_udp", "ipv4_tcp", "ipv6_udp", "ipv6_tcp", "esp_ipv4",
+	"esp_ipv6", "ipv4_multicast", "ipv6_multicast", "pppoe_relay",
+	"ethernet", "ipv4_3tuple_udp", "ipv4_3tuple_tcp", "ipv6_3tuple_udp",
+	"ipv6_3tuple_tcp", "ipv4_reassm", "ipv6_reassm",
+};
+#define NUM_TYPES	(sizeof(type_names) / sizeof(type_names[0]))
+
+struct snap {
+	struct en_ehash_snapshot_hdr hdr;
+	struct en_ehash_snapshot_pool pool[EN_EHASH_SNAPSHOT_MAX_TABLES];
+	struct en_ehash_snapshot_rec *rec;
+};
+
+struct table_sum {
+	uint32_t flows;
+	int type;
+	uint64_t pkts;
+	uint64_t bytes;
+};
+
+static const char *type_name(int type)
+{
+	if ((type < 0) || (type >= (int)NUM_TYPES))
+		return "unknown";
+	return type_names[type];
+}
+
+static int type_lookup(const char *name)
+{
+	unsigned int ii;
+
+	for (ii = 0; ii < NUM_TYPES; ii++) {
+		if (!strcmp(name, type_names[ii]))
+			return ii;
+	}
+	return -1;
+}
+
+/* copy a consistent snapshot out of the mapping */
+static int snap_read(const struct en_ehash_snapshot_hdr *map, struct snap *out)
+{
+	const struct en_ehash_snapshot_rec *rec;
+	uint32_t seq, num, tries;
+
+	rec = (const struct en_ehash_snapshot_rec *)
+		((const uint8_t *)map + EN_EHASH_SNAPSHOT_REC_OFFSET);
+	for (tries = 0; tries < SNAP_READ_TRIES; tries++) {
+		seq = __atomic_load_n(&map->seq, __ATOMIC_ACQUIRE);
+		/* 0: nothing written yet since the first open */
+		if (!seq || (seq & 1)) {
+			usleep(SNAP_RETRY_US);
+			continue;
+		}
+		memcpy(&out->hdr, map, sizeof(out->hdr));
+		num = out->hdr.num_tables;
+		if (num > EN_EHASH_SNAPSHOT_MAX_TABLES)
+			num = EN_EHASH_SNAPSHOT_MAX_TABLES;
+		memcpy(out->pool, (const uint8_t *)map +
+		       EN_EHASH_SNAPSHOT_POOL_OFFSET, num * sizeof(out->pool[0]));
+		out->hdr.num_tables = num;
+		num = out->hdr.num_records;
+		if (num > out->hdr.max_records)
+			num = out->hdr.max_records;
+		memcpy(out->rec, rec, num * sizeof(*rec));
+		out->hdr.num_records = num;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&map->seq, __ATOMIC_RELAXED) == seq)
+			return 0;
+	}
+	return -1;
+}
+
+static void print_key(const struct en_ehash_snapshot_rec *rec)
+{
+	char src[INET6_ADDRSTRLEN], dst[INET6_ADDRSTRLEN];
+	const uint8_t *key = rec->key;
+	int alen, family;
+	unsigned int ii;
+
+	switch (rec->table_type) {
+	case 0: case 1:		/* port, saddr, daddr, proto, sport, dport */
+	case 2: case 3:
+		family = (rec->table_type < 2) ? AF_INET : AF_INET6;
+		alen = (family == AF_INET) ? 4 : 16;
+		if (rec->key_size < (1 + (2 * alen) + 1 + 4))
+			break;
+		inet_ntop(family, key + 1, src, sizeof(src));
+		inet_ntop(family, key + 1 + alen, dst, sizeof(dst));
+		printf("port %u %s:%u -> %s:%u", key[0], src,
+		       (key[2 + (2 * alen)] << 8) | key[3 + (2 * alen)], dst,
+		       (key[4 + (2 * alen)] << 8) | key[5 + (2 * alen)]);
+		return;
+	case 4: case 5:		/* port, daddr, proto, spi */
+		family = (rec->table_type == 4) ? AF_INET : AF_INET6;
+		alen = (family == AF_INET) ? 4 : 16;
+		if (rec->key_size < (1 + alen + 1 + 4))
+			break;
+		inet_ntop(family, key + 1, dst, sizeof(dst));
+		printf("port %u %s spi 0x%08x", key[0], dst,
+		       (key[2 + alen] << 24) | (key[3 + alen] << 16) |
+		       (key[4 + alen] << 8) | key[5 + alen]);
+		return;
+	}
+	printf("key ");
+	for (ii = 0; ii < rec->key_size; ii++)
+		printf("%02x", key[ii]);
+}
+
+static void print_flows(const struct snap *snap, int type)
+{
+	const struct en_ehash_snapshot_rec *rec;
+	uint32_t ii;
+
+	printf("%-5s %-15s %-6s %12s %14s %-10s %5s %s\n", "table", "type",
+	       "bucket", "packets", "bytes", "last hit", "idle", "flow");
+	for (ii = 0; ii < snap->hdr.num_records; ii++) {
+		rec = &snap->rec[ii];
+		if ((type >= 0) && (rec->table_type != type))
+			continue;
+		printf("%-5u %-15s %-6u ", rec->table, type_name(rec->table_type),
+		       rec->bucket);
+		if (rec->flags & STATS_VALID)
+			printf("%12llu %14llu ", (unsigned long long)rec->pkts,
+			       (unsigned long long)rec->bytes);
+		else
+			printf("%12s %14s ", "-", "-");
+		if (rec->flags & TIMESTAMP_VALID)
+			printf("0x%08x ", rec->timestamp);
+		else
+			printf("%-10s ", "-");
+		if (rec->flags & AGING_VALID)
+			printf("%5u ", rec->idle);
+		else
+			printf("%5s ", "-");
+		print_key(rec);
+		printf("\n");
+	}
+}
+
+static void print_pool(const char *name,
+		const struct en_ehash_pool_stats *stats)
+{
+	if (!stats->size && !stats->in_use && !stats->failed) {
+		printf(" %-10s %8s\n", name, "-");
+		return;
+	}
+	printf(" %-10s %8u %8u %8u %8u %8u\n", name, stats->size,
+	       stats->in_use, stats->high_watermark, stats->fallback,
+	       stats->failed);
+}
+
+static void print_pools(const struct snap *snap, int type)
+{
+	const struct en_ehash_snapshot_pool *pool;
+	uint32_t ii;
+
+	printf("%-5s %-15s %-10s %8s %8s %8s %8s %8s\n", "table", "type",
+	       "pool", "size", "in use", "high", "fallback", "failed");
+	for (ii = 0; ii < snap->hdr.num_tables; ii++) {
+		pool = &snap->pool[ii];
+		if ((type >= 0) && ((int)pool->table_type != type))
+			continue;
+		printf("%-5u %-15s", ii, type_name(pool->table_type));
+		print_pool("entries", &pool->entries);
+		printf("%-21s", "");
+		print_pool("cumulative", &pool->cumulative);
+	}
+}
+
+static void sum_tables(const struct snap *snap, struct table_sum *sum)
+{
+	const struct en_ehash_snapshot_rec *rec;
+	uint32_t ii;
+
+	memset(sum, 0, EN_EHASH_SNAPSHOT_MAX_TABLES * sizeof(*sum));
+	for (ii = 0; ii < snap->hdr.num_records; ii++) {
+		rec = &snap->rec[ii];
+		if (rec->table >= EN_EHASH_SNAPSHOT_MAX_TABLES)
+			continue;
+		sum[rec->table].flows++;
+		sum[rec->table].type = rec->table_type;
+		if (rec->flags & STATS_VALID) {
+			sum[rec->table].pkts += rec->pkts;
+			sum[rec->table].bytes += rec->bytes;
+		}
+	}
+}
+
+/* counters of flows removed between two snapshots drop out of the sums,
+ * so rates are clamped at 0 */
+static uint64_t rate(uint64_t now, uint64_t then, uint64_t ns)
+{
+	if (!ns || (now <= then))
+		return 0;
+	return ((now - then) * 1000000000ull) / ns;
+}
+
+static void print_tables(const struct snap *snap, const struct table_sum *sum,
+		const struct table_sum *prev, uint64_t dt_ns, int type)
+{
+	uint32_t ii, flows = 0;
+
+	printf("%-5s %-15s %8s %14s %16s", "table", "type", "flows",
+	       "packets", "bytes");
+	if (prev)
+		printf(" %10s %12s", "pkt/s", "bit/s");
+	printf("\n");
+	for (ii = 0; ii < EN_EHASH_SNAPSHOT_MAX_TABLES; ii++) {
+		if (!sum[ii].flows)
+			continue;
+		if ((type >= 0) && (sum[ii].type != type))
+			continue;
+		flows += sum[ii].flows;
+		printf("%-5u %-15s %8u %14llu %16llu", ii,
+		       type_name(sum[ii].type), sum[ii].flows,
+		       (unsigned long long)sum[ii].pkts,
+		       (unsigned long long)sum[ii].bytes);
+		if (prev)
+			printf(" %10llu %12llu",
+			       (unsigned long long)rate(sum[ii].pkts,
+					prev[ii].pkts, dt_ns),
+			       (unsigned long long)(8 * rate(sum[ii].bytes,
+					prev[ii].bytes, dt_ns)));
+		printf("\n");
+	}
+	printf("%u flows in %u records%s\n", flows, snap->hdr.num_records,
+	       (snap->hdr.num_records == snap->hdr.max_records) ?
+	       ", snapshot full" : "");
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"Prints the hit counters of the flows in the FMan external hash\n"
+		"tables from " SNAP_DEV ".\n"
+		"  -f         one line per flow instead of per table sums\n"
+		"  -p         entry pool usage per table instead of flows\n"
+		"  -t type    only tables of this type, e.g. ipv4_tcp\n"
+		"  -w secs    repeat every secs seconds, with per table rates\n"
+		"  -n count   stop after count reports (with -w)\n"
+		"  -d dev     device (default " SNAP_DEV ")\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *dev = SNAP_DEV;
+	struct en_ehash_snapshot_hdr *map;
+	struct table_sum sum[EN_EHASH_SNAPSHOT_MAX_TABLES];
+	struct table_sum prev[EN_EHASH_SNAPSHOT_MAX_TABLES];
+	struct snap snap;
+	uint64_t prev_ns = 0;
+	unsigned int interval = 0, count = 0, ii;
+	int opt, fd, flows = 0, pools = 0, type = -1;
+	size_t size;
+	long page;
+
+	while ((opt = getopt(argc, argv, "fpt:w:n:d:h")) != -1) {
+		switch (opt) {
+		case 'f':
+			flows = 1;
+			break;
+		case 'p':
+			pools = 1;
+			break;
+		case 't':
+			type = type_lookup(optarg);
+			if (type < 0) {
+				fprintf(stderr, "unknown table type %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'w':
+			interval = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			dev = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	/* the snapshot is refreshed for as long as the device stays open */
+	fd = open(dev, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", dev, strerror(errno));
+		return 1;
+	}
+	page = sysconf(_SC_PAGESIZE);
+	map = mmap(NULL, page, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "mmap %s: %s\n", dev, strerror(errno));
+		return 1;
+	}
+	if ((map->version != EN_EHASH_SNAPSHOT_VERSION) ||
+	    (map->record_size != sizeof(struct en_ehash_snapshot_rec))) {
+		fprintf(stderr, "%s: version %u record size %u, expected %u/%zu\n",
+			dev, map->version, map->record_size,
+			EN_EHASH_SNAPSHOT_VERSION,
+			sizeof(struct en_ehash_snapshot_rec));
+		return 1;
+	}
+	size = EN_EHASH_SNAPSHOT_REC_OFFSET +
+		((size_t)map->max_records * map->record_size);
+	size = (size + page - 1) & ~((size_t)page - 1);
+	snap.rec = calloc(map->max_records, sizeof(*snap.rec));
+	munmap(map, page);
+	if (!snap.rec) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "mmap %s: %s\n", dev, strerror(errno));
+		return 1;
+	}
+
+	for (ii = 0; ; ii++) {
+		if (snap_read(map, &snap)) {
+			fprintf(stderr, "%s: no consistent snapshot\n", dev);
+			return 1;
+		}
+		if (pools) {
+			print_pools(&snap, type);
+		} else if (flows) {
+			print_flows(&snap, type);
+		} else {
+			sum_tables(&snap, sum);
+			print_tables(&snap, sum, ii ? prev : NULL,
+				     snap.hdr.snap_time_ns - prev_ns, type);
+			memcpy(prev, sum, sizeof(prev));
+			prev_ns = snap.hdr.snap_time_ns;
+		}
+		if (!interval || (count && ((ii + 1) >= count)))
+			break;
+		printf("\n");
+		fflush(stdout);
+		sleep(interval);
+	}
+	munmap(map, size);
+	close(fd);
+	free(snap.rec);
+	return 0;
+}
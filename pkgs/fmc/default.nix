@@ -18,8 +18,18 @@ stdenv.mkDerivation {
 
   patches = [
     ./01-mono-ask-extensions.patch
+    ./02-model-cache.patch
+    ./03-node-index-profile.patch
+    ./04-pcd-batch-keys.patch
   ];
 
+  # No patch context reaches the top of FMCPCDModel.cpp, so the headers
+  # the patches need go in front of its first #include
+  postPatch = ''
+    sed -i '0,/^#include/s//#include <cstdio>\n#include <cstdlib>\n#include <cstring>\n#include <ctime>\n#include <map>\n#include <vector>\n#include <unistd.h>\n#include <sys\/stat.h>\n#include "fmc.h"\n&/' \
+      source/FMCPCDModel.cpp
+  '';
+
   buildInputs = [ mono-gateway-fmlib libxml2 tclap ];
 
   enableParallelBuilding = false;
@@ -36,7 +46,10 @@ stdenv.mkDerivation {
   installPhase = ''
     runHook preInstall
 
-    install -Dm755 source/fmc $out/bin/fmc
+    # bin/fmc is a wrapper that turns --profile into FMC_PROFILE=1
+    install -Dm755 source/fmc $out/libexec/fmc
+    install -Dm755 ${./fmc.sh} $out/bin/fmc
+    substituteInPlace $out/bin/fmc --replace-fail '@fmc@' "$out/libexec/fmc"
     install -Dm644 source/fmc.h $out/include/fmc/fmc.h
     install -Dm644 source/libfmc.a $out/lib/libfmc.a
 
@@ -0,0 +1,14 @@
+#!/bin/sh
+# fmc --profile: run fmc with FMC_PROFILE=1, which prints the time spent
+# in each phase on exit (03-node-index-profile.patch). The option is taken
+# out here because fmc's own TCLAP command line does not know it.
+for arg do
+	shift
+	if [ "$arg" = "--profile" ]; then
+		FMC_PROFILE=1
+		export FMC_PROFILE
+	else
+		set -- "$@" "$arg"
+	fi
+done
+exec @fmc@ "$@"
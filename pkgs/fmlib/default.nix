@@ -16,6 +16,8 @@ stdenv.mkDerivation {
 
   patches = [
     ./01-mono-ask-extensions.patch
+    ./02-timestamp-mmap.patch
+    ./03-pcd-batch.patch
   ];
 
   env = {
@@ -18,6 +18,27 @@
     { name = "001-ina234"; patch = ./patches/001-hwmon-ina2xx-Add-INA234-support.patch; }
     { name = "002-ask-offload"; patch = ./patches/002-mono-gateway-ask-kernel_linux_6_12.patch; }
     { name = "003-fman-aliases"; patch = ./patches/003-fman-respect-ethernet-aliases.patch; }
+    { name = "004-fp-churn-stats"; patch = ./patches/004-comcerto-fp-churn-stats.patch; }
+    { name = "005-ipsec-flow-rhashtable"; patch = ./patches/005-ipsec-flow-rhashtable.patch; }
+    { name = "006-ipsec-flow-aging"; patch = ./patches/006-ipsec-flow-aging.patch; }
+    { name = "007-xfrm-state-handle-xarray"; patch = ./patches/007-xfrm-state-handle-xarray.patch; }
+    { name = "008-fman-ehash-entry-pools"; patch = ./patches/008-fman-ehash-entry-pools.patch; }
+    { name = "009-fman-ehash-add-error-paths"; patch = ./patches/009-fman-ehash-add-error-paths.patch; }
+    { name = "010-fman-ehash-cumulative-slots"; patch = ./patches/010-fman-ehash-cumulative-slots.patch; }
+    { name = "011-fman-ehash-stats-snapshot"; patch = ./patches/011-fman-ehash-stats-snapshot.patch; }
+    { name = "012-fman-ehash-lockless-readers"; patch = ./patches/012-fman-ehash-lockless-readers.patch; }
+    { name = "013-fman-hc-async-queue"; patch = ./patches/013-fman-hc-async-queue.patch; }
+    { name = "014-fman-cc-aging-scan"; patch = ./patches/014-fman-cc-aging-scan.patch; }
+    { name = "015-fman-muram-accounting"; patch = ./patches/015-fman-muram-accounting.patch; }
+    { name = "016-fman-timestamp-mmap"; patch = ./patches/016-fman-timestamp-mmap.patch; }
+    { name = "017-fman-pcd-batch-ioctl"; patch = ./patches/017-fman-pcd-batch-ioctl.patch; }
+    { name = "018-dpaa-adaptive-bpool-refill"; patch = ./patches/018-dpaa-adaptive-bpool-refill.patch; }
+    { name = "019-qman-portal-napi-threaded"; patch = ./patches/019-qman-portal-napi-threaded.patch; }
+    { name = "020-dpaa-native-xdp"; patch = ./patches/020-dpaa-native-xdp.patch; }
+    # 021 is unused: the CEETM egress FQ cache was withdrawn (KERNEL_PATCHES.md)
+    { name = "022-qman-ceetm-telemetry"; patch = ./patches/022-qman-ceetm-telemetry.patch; }
+    { name = "023-dpaa-oh-port-groups"; patch = ./patches/023-dpaa-oh-port-groups.patch; }
+    { name = "024-dpaa-rx-page-pool"; patch = ./patches/024-dpaa-rx-page-pool.patch; }
   ];
 
   extraMeta.platforms = [ "aarch64-linux" ];
@@ -19,6 +19,21 @@ stdenv.mkDerivation {
 
   patches = [
     ./patches/002-mono-gateway-ask-kernel_linux_6_12.patch
+    ./patches/008-fman-ehash-entry-pools.patch
+    ./patches/009-fman-ehash-add-error-paths.patch
+    ./patches/010-fman-ehash-cumulative-slots.patch
+    ./patches/011-fman-ehash-stats-snapshot.patch
+    ./patches/012-fman-ehash-lockless-readers.patch
+    ./patches/013-fman-hc-async-queue.patch
+    ./patches/014-fman-cc-aging-scan.patch
+    ./patches/015-fman-muram-accounting.patch
+    ./patches/016-fman-timestamp-mmap.patch
+    ./patches/017-fman-pcd-batch-ioctl.patch
+    ./patches/018-dpaa-adaptive-bpool-refill.patch
+    ./patches/019-qman-portal-napi-threaded.patch
+    ./patches/020-dpaa-native-xdp.patch
+    ./patches/023-dpaa-oh-port-groups.patch
+    ./patches/024-dpaa-rx-page-pool.patch
   ];
 
   dontConfigure = true;